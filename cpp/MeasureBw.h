@@ -0,0 +1,41 @@
+//=================================================================================================
+// MeasureBw.h - Defines the register map of the "measure_bw" RTL core
+//=================================================================================================
+#pragma once
+#include <stdint.h>
+
+// Register map for the "measure_bw" RTL core
+enum 
+{
+   REG_RADDR_H   = 0,
+   REG_RADDR_L   = 1,
+   REG_WADDR_H   = 2,
+   REG_WADDR_L   = 3,
+   REG_BLK_SIZE  = 4,
+   REG_COUNT     = 5,
+   REG_RRESULT_H = 6,
+   REG_RRESULT_L = 7,
+   REG_WRESULT_H = 8,
+   REG_WRESULT_L = 9,
+   REG_CTL_STAT  = 10,
+   REG_TRC_CTL   = 11,
+   REG_TRC_COUNT = 12,
+   REG_TRC_INDEX = 13,
+   REG_TRC_DAT_H = 14,
+   REG_TRC_DAT_L = 15
+};
+
+// These are the constants to write to the CTL_STAT register 
+const int START_READ  = 1;
+const int START_WRITE = 2;
+
+// These are the constants to write to the TRC_CTL register
+const uint32_t TRC_ARM      = 1;
+const uint32_t TRC_STOP     = 4;
+const uint32_t TRC_ONE_SHOT = 8;
+
+// This is the "buffer has wrapped" bit when reading the TRC_CTL register
+const uint32_t TRC_WRAPPED  = 4;
+
+// These bits always read as 0 in the TRC_CTL register
+const uint32_t TRC_ZERO_BITS = 0x00FFFFF0;
@@ -0,0 +1,266 @@
+//=================================================================================================
+// TraceDumper.cpp - Implements a class that reads the "measure_bw" trace buffer and writes it to
+//                   a file in Chrome trace JSON format (viewable in Perfetto or chrome://tracing)
+//=================================================================================================
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "TraceDumper.h"
+#include "MeasureBw.h"
+using namespace std;
+
+#define c(s) s.c_str()
+
+// These are the event-mask bits in bits 63:60 of a trace entry
+const int EVT_AR = 1;
+const int EVT_R  = 2;
+const int EVT_AW = 4;
+const int EVT_B  = 8;
+
+// The trace viewer "thread" that each type of event is displayed on
+const int TID_AR = 1;
+const int TID_R  = 2;
+const int TID_AW = 3;
+const int TID_B  = 4;
+
+
+//=================================================================================================
+// throwRuntime() - Throws a runtime exception
+//=================================================================================================
+static void throwRuntime(const char* fmt, ...)
+{
+    char buffer[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    vsprintf(buffer, fmt, ap);
+    va_end(ap);
+
+    throw runtime_error(buffer);
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// open() - Creates the output file and starts the JSON array of trace events
+//=================================================================================================
+void TraceDumper::open(string filename, bool oneShot)
+{
+    // If we already have a file open, finish it
+    close();
+
+    // Create the output file
+    ofile_ = fopen(c(filename), "w");
+
+    // If we couldn't create the file, tell the caller
+    if (ofile_ == nullptr) throwRuntime("Can't create %s", c(filename));
+
+    // Save the trace mode for when we arm the trace buffer
+    oneShot_ = oneShot;
+
+    // No traces or events have been written yet
+    pid_ = 0;
+    eventCount_ = 0;
+
+    // Chrome trace "JSON Array Format" is just an array of events
+    fprintf(ofile_, "[\n");
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// close() - Finishes the JSON array and closes the output file
+//=================================================================================================
+void TraceDumper::close()
+{
+    if (ofile_)
+    {
+        fprintf(ofile_, "\n]\n");
+        fclose(ofile_);
+        ofile_ = nullptr;
+    }
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// writeEvent() - Writes a single JSON event to the output file, separated from the previous one
+//=================================================================================================
+void TraceDumper::writeEvent(const char* fmt, ...)
+{
+    va_list ap;
+
+    // Every event after the first is preceded by a comma
+    if (eventCount_++) fprintf(ofile_, ",\n");
+
+    va_start(ap, fmt);
+    vfprintf(ofile_, fmt, ap);
+    va_end(ap);
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// traceDepth() - Returns the number of entries in the trace buffer
+//
+// Passed: status = the value read from the REG_TRC_CTL register
+//
+// An FPGA image without a trace buffer returns 0x0DEC0DE0 for unknown registers, so the bits
+// that should always be zero are checked along with the depth
+//=================================================================================================
+uint32_t TraceDumper::traceDepth(uint32_t status)
+{
+    uint32_t log2_depth = status >> 24;
+
+    // If the depth is zero or absurd, or the always-zero bits aren't, there's no trace buffer
+    if (log2_depth == 0 || log2_depth > 20 || (status & TRC_ZERO_BITS) != 0)
+    {
+        throwRuntime("No trace buffer found in measure_bw core");
+    }
+
+    return 1 << log2_depth;
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// probe() - Throws an exception if this "measure_bw" core has no trace buffer.  This should be
+//           called before any measurements are taken.
+//
+// Passed: engine = pointer to the AXI registers of the "measure_bw" core
+//=================================================================================================
+void TraceDumper::probe(volatile uint32_t* engine)
+{
+    // If we're not tracing, there's nothing to do
+    if (ofile_ == nullptr) return;
+
+    // This throws if there is no trace buffer
+    traceDepth(engine[REG_TRC_CTL]);
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// arm() - Clears the trace buffer and arms it.  The next measurement started on this core
+//         triggers the trace.
+//
+// Passed: engine = pointer to the AXI registers of the "measure_bw" core
+//=================================================================================================
+void TraceDumper::arm(volatile uint32_t* engine)
+{
+    // If we're not tracing, there's nothing to do
+    if (ofile_ == nullptr) return;
+
+    // Arm the trace buffer in either ring or one-shot mode
+    engine[REG_TRC_CTL] = oneShot_ ? TRC_ARM | TRC_ONE_SHOT : TRC_ARM;
+}
+//=================================================================================================
+
+
+//=================================================================================================
+// dump() - Stops the trace buffer, reads out every entry, and writes them to the output file
+//
+// Passed: engine     = pointer to the AXI registers of the "measure_bw" core
+//         name       = the name this trace will have in the trace viewer
+//         clockSpeed = the clock speed (in MHz) the "measure_bw" core is driven at
+//
+// Each handshake is written as an instant event, and the number of outstanding read and write
+// bursts are written as counters.  Timestamps are in microseconds since the trigger.
+//=================================================================================================
+void TraceDumper::dump(volatile uint32_t* engine, string name, double clockSpeed)
+{
+    // If we're not tracing, there's nothing to do
+    if (ofile_ == nullptr) return;
+
+    // Stop recording so the buffer doesn't change while we read it
+    engine[REG_TRC_CTL] = TRC_STOP;
+
+    // Find out how big the trace buffer is and how many entries were recorded
+    uint32_t status = engine[REG_TRC_CTL];
+    uint32_t count  = engine[REG_TRC_COUNT];
+    uint32_t depth  = traceDepth(status);
+
+    // If the buffer wrapped, it's full and the oldest entry is the one that will be overwritten next
+    bool     wrapped = (status & TRC_WRAPPED) != 0;
+    uint32_t entries = (wrapped || count > depth) ? depth : count;
+    uint32_t first   = wrapped ? count % depth : 0;
+
+    // Read out every entry, oldest first
+    vector<uint64_t> entry(entries);
+    for (uint32_t i = 0; i < entries; ++i)
+    {
+        // Select the entry
+        engine[REG_TRC_INDEX] = (first + i) % depth;
+
+        // Fetch the 64-bit entry
+        uint64_t hi = engine[REG_TRC_DAT_H];
+        uint64_t lo = engine[REG_TRC_DAT_L];
+        entry[i] = (hi << 32) | lo;
+    }
+
+    // If the buffer wrapped, the outstanding counts are relative.  Find their minimums so that
+    // we can shift the counters to start from zero
+    int reads = 0, writes = 0, minReads = 0, minWrites = 0;
+    for (auto e : entry)
+    {
+        int events = e >> 60;
+        if (events & EVT_AR) ++reads;
+        if (events & EVT_R ) --reads;
+        if (events & EVT_AW) ++writes;
+        if (events & EVT_B ) --writes;
+        if (reads  < minReads ) minReads  = reads;
+        if (writes < minWrites) minWrites = writes;
+    }
+
+    // This trace gets its own process in the trace viewer
+    ++pid_;
+
+    // Name the process and the "threads" that each type of event is displayed on
+    writeEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}", pid_, c(name));
+    writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"AR\"}}", pid_, TID_AR);
+    writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"R last\"}}", pid_, TID_R);
+    writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"AW\"}}", pid_, TID_AW);
+    writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"B\"}}", pid_, TID_B);
+
+    // Now write out the events
+    reads  = -minReads;
+    writes = -minWrites;
+    for (auto e : entry)
+    {
+        int    events = e >> 60;
+        int    arid   = (e >> 56) & 0xF;
+        int    awid   = (e >> 52) & 0xF;
+        double ts     = (e & 0xFFFFFFFFFFFF) / clockSpeed;
+
+        if (events & EVT_AR)
+            writeEvent("{\"name\":\"AR\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3lf,\"args\":{\"id\":%d}}", pid_, TID_AR, ts, arid);
+
+        if (events & EVT_R)
+            writeEvent("{\"name\":\"R last\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3lf}", pid_, TID_R, ts);
+
+        if (events & EVT_AW)
+            writeEvent("{\"name\":\"AW\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3lf,\"args\":{\"id\":%d}}", pid_, TID_AW, ts, awid);
+
+        if (events & EVT_B)
+            writeEvent("{\"name\":\"B\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3lf}", pid_, TID_B, ts);
+
+        // Keep track of how many read bursts are outstanding
+        if (events & (EVT_AR | EVT_R))
+        {
+            if (events & EVT_AR) ++reads;
+            if (events & EVT_R ) --reads;
+            writeEvent("{\"name\":\"Outstanding reads\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3lf,\"args\":{\"value\":%d}}", pid_, ts, reads);
+        }
+
+        // Keep track of how many write bursts are outstanding
+        if (events & (EVT_AW | EVT_B))
+        {
+            if (events & EVT_AW) ++writes;
+            if (events & EVT_B ) --writes;
+            writeEvent("{\"name\":\"Outstanding writes\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3lf,\"args\":{\"value\":%d}}", pid_, ts, writes);
+        }
+    }
+}
+//=================================================================================================
@@ -0,0 +1,61 @@
+//=================================================================================================
+// TraceDumper.h - Defines a class that reads the "measure_bw" trace buffer and writes it to a
+//                 file in Chrome trace JSON format (viewable in Perfetto or chrome://tracing)
+//=================================================================================================
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+
+class TraceDumper
+{
+public:
+
+    // Default constructor
+    TraceDumper() {};
+
+    // Destructor
+    ~TraceDumper() {close();}
+
+    // No copy or assignment constructor - objects of this class can't be copied
+    TraceDumper (const TraceDumper&) = delete;
+    TraceDumper& operator= (const TraceDumper&) = delete;
+
+    // Creates the output file.  If "oneShot" is true, tracing stops when the buffer fills
+    void    open(std::string filename, bool oneShot = false);
+
+    // Returns true if there is an output file open
+    bool    isOpen() {return ofile_ != nullptr;}
+
+    // Throws an exception if a "measure_bw" core has no trace buffer
+    void    probe(volatile uint32_t* engine);
+
+    // Arms the trace buffer of a "measure_bw" core so the next measurement triggers it
+    void    arm(volatile uint32_t* engine);
+
+    // Stops the trace buffer of a "measure_bw" core and writes its contents to the output file
+    void    dump(volatile uint32_t* engine, std::string name, double clockSpeed);
+
+    // Finishes the JSON and closes the output file
+    void    close();
+
+protected:
+
+    // Returns the number of entries in the trace buffer, given the REG_TRC_CTL status
+    uint32_t traceDepth(uint32_t status);
+
+    // Writes a single JSON event to the output file
+    void    writeEvent(const char* fmt, ...);
+
+    // The output file
+    FILE*   ofile_ = nullptr;
+
+    // When true, the trace buffer stops recording when full instead of wrapping
+    bool    oneShot_ = false;
+
+    // Each dumped trace becomes its own "process" in the trace viewer
+    int     pid_ = 0;
+
+    // The number of JSON events written so far
+    int     eventCount_ = 0;
+};
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <time.h>
 #include "PciDevice.h"
+#include "TraceDumper.h"
+#include "MeasureBw.h"
 
 // Extract the high and low 32-bits of a 64-bit word
 #define HI32(x) ((x >> 32) & 0xFFFFFFFF)
@@ -17,6 +19,9 @@
 // This maps PCI resources into user-space
 PciDevice PCI;
 
+// This writes the on-chip AXI transaction traces to a Chrome trace JSON file
+TraceDumper Trace;
+
 // This defines which PCI resource (i.e., BAR) has the AXI slave registers mapped
 const int AXIREG_RESOURCE = 0;
 
@@ -31,25 +36,15 @@ const int MBW_DDR = 0x2000;
 const double PCI_CLOCK_SPEED = 250.0;
 const double DDR_CLOCK_SPEED = 266.5;
 
-// Register map for the "measure_bw" RTL core
-enum 
-{
-   REG_RADDR_H   = 0,
-   REG_RADDR_L   = 1,
-   REG_WADDR_H   = 2,
-   REG_WADDR_L   = 3,
-   REG_BLK_SIZE  = 4,
-   REG_COUNT     = 5,
-   REG_RRESULT_H = 6,
-   REG_RRESULT_L = 7,
-   REG_WRESULT_H = 8,
-   REG_WRESULT_L = 9,
-   REG_CTL_STAT  = 10
-};
 
-// These are the constants to write to the CTL_STAT register 
-const int START_READ  = 1;
-const int START_WRITE = 2;
+//=================================================================================================
+// engineRegs() - Returns a pointer to the AXI registers of a bandwidth measurement core
+//=================================================================================================
+volatile uint32_t* engineRegs(uint32_t deviceAddress)
+{
+   return (uint32_t*) (PCI.resourceList()[AXIREG_RESOURCE].baseAddr + deviceAddress);
+}
+//=================================================================================================
 
 
 
@@ -67,7 +62,7 @@ uint64_t measureReadBandwidth(uint32_t deviceAddress, uint64_t axiAddress, uint3
 {
 
    // Get a pointer to our measurement engine's AXI registers
-   volatile uint32_t* engine = (uint32_t*) (PCI.resourceList()[AXIREG_RESOURCE].baseAddr + deviceAddress);
+   volatile uint32_t* engine = engineRegs(deviceAddress);
 
    // Configure the bandwith measurement core
    engine[REG_RADDR_H ] = HI32(axiAddress);
@@ -104,7 +99,7 @@ uint64_t measureWriteBandwidth(uint32_t deviceAddress, uint64_t axiAddress, uint
                                uint32_t blockCount)
 {
    // Get a pointer to our measurement engine's AXI registers
-   volatile uint32_t* engine = (uint32_t*) (PCI.resourceList()[AXIREG_RESOURCE].baseAddr + deviceAddress);
+   volatile uint32_t* engine = engineRegs(deviceAddress);
 
    // Configure the bandwith measurement core
    engine[REG_WADDR_H ] = HI32(axiAddress);
@@ -151,9 +146,15 @@ void process(uint64_t contigAddress)
    // >>>>>>>>>>>>>>>>>>>>  Measure PCI write bandwidth  <<<<<<<<<<<<<<<<<<<<
    //-----------------------------------------------------------------------
 
+   // If we're tracing, arm the trace buffer so this measurement triggers it
+   Trace.arm(engineRegs(MBW_PCI));
+
    // Measure the number of clock cycles required to read the data from the PCI bus
    cycles = measureWriteBandwidth(MBW_PCI, contigAddress, burstSize, xferSize / burstSize);
 
+   // If we're tracing, save the trace of this measurement
+   Trace.dump(engineRegs(MBW_PCI), "PCI write", PCI_CLOCK_SPEED);
+
    // Translate the measured number of clock cycles into nanoseconds
    nanoseconds = cycles * 1000 / PCI_CLOCK_SPEED;
    
@@ -167,9 +168,15 @@ void process(uint64_t contigAddress)
    // >>>>>>>>>>>>>>>>>>>>  Measure DDR write bandwidth  <<<<<<<<<<<<<<<<<<<<
    //-----------------------------------------------------------------------
 
+   // If we're tracing, arm the trace buffer so this measurement triggers it
+   Trace.arm(engineRegs(MBW_DDR));
+
    // Measure the number of clock cycles required to read the data from the PCI bus
    cycles = measureWriteBandwidth(MBW_DDR, 0, burstSize, xferSize / burstSize);
 
+   // If we're tracing, save the trace of this measurement
+   Trace.dump(engineRegs(MBW_DDR), "DDR write", DDR_CLOCK_SPEED);
+
    // Translate the measured number of clock cycles into nanoseconds
    nanoseconds = cycles * 1000 / DDR_CLOCK_SPEED;
    
@@ -183,9 +190,15 @@ void process(uint64_t contigAddress)
    // >>>>>>>>>>>>>>>>>>>>  Measure PCI read bandwidth  <<<<<<<<<<<<<<<<<<<<
    //-----------------------------------------------------------------------
 
+   // If we're tracing, arm the trace buffer so this measurement triggers it
+   Trace.arm(engineRegs(MBW_PCI));
+
    // Measure the number of clock cycles required to read the data from the PCI bus
    cycles = measureReadBandwidth(MBW_PCI, contigAddress, burstSize, xferSize / burstSize);
 
+   // If we're tracing, save the trace of this measurement
+   Trace.dump(engineRegs(MBW_PCI), "PCI read", PCI_CLOCK_SPEED);
+
    // Translate the measured number of clock cycles into nanoseconds
    nanoseconds = cycles * 1000 / PCI_CLOCK_SPEED;
    
@@ -199,9 +212,15 @@ void process(uint64_t contigAddress)
    // >>>>>>>>>>>>>>>>>>>>  Measure DDR read bandwidth  <<<<<<<<<<<<<<<<<<<<
    //-----------------------------------------------------------------------
    
+   // If we're tracing, arm the trace buffer so this measurement triggers it
+   Trace.arm(engineRegs(MBW_DDR));
+
    // Measure the number of clock cycles required to read the data from the PCI bus
    cycles = measureReadBandwidth(MBW_DDR, 0, burstSize, xferSize / burstSize);
 
+   // If we're tracing, save the trace of this measurement
+   Trace.dump(engineRegs(MBW_DDR), "DDR read", DDR_CLOCK_SPEED);
+
    // Translate the measured number of clock cycles into nanoseconds
    nanoseconds = cycles * 1000 / DDR_CLOCK_SPEED;
    
@@ -218,19 +237,51 @@ void process(uint64_t contigAddress)
 
 //=================================================================================================
 // main() - Execution begins here
+//
+// Command line: measure_bw [-trace <filename.json>] [-oneshot]
+//
+//    -trace   = Record the AXI transactions of each measurement into a Chrome trace JSON file
+//    -oneshot = Record the first transactions of each measurement rather than the last ones
 //=================================================================================================
-int main()
+int main(int argc, char** argv)
 {
+   const char* traceFilename = nullptr;
+   bool        oneShot = false;
+
+   // Parse the command line
+   for (int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-trace") == 0 && i + 1 < argc)
+         traceFilename = argv[++i];
+      else if (strcmp(argv[i], "-oneshot") == 0)
+         oneShot = true;
+      else
+      {
+         printf("Usage: measure_bw [-trace <filename.json>] [-oneshot]\n");
+         return 1;
+      }
+   }
+
    try
    {
+      // If the user asked for a trace, create the trace file
+      if (traceFilename) Trace.open(traceFilename, oneShot);
+
       // Map the Sidewinder's PCI resources into userspace
       PCI.open(0x10ee, 0x903f);
 
       // Find the address of the reserved contiguous buffer
       uint64_t contigAddress = findContig();
 
+      // If we're tracing, make sure both cores have a trace buffer before measuring anything
+      Trace.probe(engineRegs(MBW_PCI));
+      Trace.probe(engineRegs(MBW_DDR));
+
       // And go measure and report our bandwidth 
       process(contigAddress);
+
+      // Finish writing the trace file
+      Trace.close();
    }
 
    catch(const std::exception& e)
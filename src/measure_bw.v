@@ -7,13 +7,14 @@
 //   Date     Who   Ver  Changes
 //====================================================================================
 // 21-Jul-22  DWW  1000  Initial creation
+// 18-Oct-26  AGT  1001  Added the AXI transaction trace buffer
 //====================================================================================
 
 /*
 
     This module measures the bandwidth of an AXI interface.
 
-    On the AXI4-lite slave interface, there are eleven 32-bit registers:
+    On the AXI4-lite slave interface, there are sixteen 32-bit registers:
        Offset 0x00 : Read  starting address, hi 32 bits
        Offset 0x04 : Read  starting address, lo 32 bits
        Offset 0x08 : Write starting address, hi 32 bits
@@ -25,6 +26,11 @@
        Offset 0x20 : Result clock cycles for write, hi 32 bits
        Offset 0x24 : Result clock cycles for write, lo 32 bits
        Offset 0x28 : Control / Status
+       Offset 0x2C : Trace control / status
+       Offset 0x30 : Number of trace entries recorded since the trace was armed
+       Offset 0x34 : Trace read index
+       Offset 0x38 : Trace entry at the trace read index, hi 32 bits
+       Offset 0x3C : Trace entry at the trace read index, lo 32 bits
 
     The control/status register is bitmapped.
       During a write:
@@ -33,6 +39,32 @@
       During a read:
               Bit 0 : 0 = Read  measurement complete, 1 = read measurement in progress
               Bit 1 : 0 = Write measurement complete, 1 = write measurement in progress
+
+    The trace control/status register is bitmapped.
+      During a write:
+              Bit 0 : 0 = Do nothing, 1 = Arm (clear the trace buffer and wait for a trigger)
+              Bit 1 : 0 = Do nothing, 1 = Trigger (if armed, start recording immediately)
+              Bit 2 : 0 = Do nothing, 1 = Stop recording
+              Bit 3 : When arming, 0 = Ring mode (overwrite oldest), 1 = One-shot (stop when full)
+      During a read:
+              Bit 0     : 1 = Armed and waiting for a trigger
+              Bit 1     : 1 = Recording
+              Bit 2     : 1 = Trace buffer has wrapped (oldest entries were overwritten)
+              Bit 3     : 1 = One-shot mode
+              Bits 31:24: log2 of the number of entries in the trace buffer
+
+    Once armed, the start of a read or write bandwidth measurement is the trigger.
+
+    Every clock cycle in which at least one AR, R-last, AW, or B handshake occurs on the
+    AXI master interface records one 64-bit trace entry:
+              Bits 63:60: Event mask.  Bit 60 = AR, 61 = R with RLAST, 62 = AW, 63 = B
+              Bits 59:56: ARID (valid when bit 60 is set)
+              Bits 55:52: AWID (valid when bit 62 is set)
+              Bits 51:48: Always 0
+              Bits 47:0 : Number of clock cycles since the trigger
+
+    When the trace buffer has not wrapped, the oldest entry is at index 0.  Once it has
+    wrapped, the oldest entry is at index (entry count % trace depth).
         
 
 */
@@ -54,7 +86,8 @@ module measure_bw#
     parameter       MAX_OUTSTANDING_RREQ  = 8,
     parameter       MAX_OUTSTANDING_WREQ  = 8,
     parameter       AXI_DATA_WIDTH        = 512,
-    parameter       AXI_ADDR_WIDTH        = 64
+    parameter       AXI_ADDR_WIDTH        = 64,
+    parameter       TRACE_DEPTH           = 4096
 )
 (
     input wire  AXI_ACLK, AXI_ARESETN,
@@ -166,6 +199,14 @@ module measure_bw#
     localparam REG_WRESULT_H =  8;    // Elapsed write clock-cycles, hi word
     localparam REG_WRESULT_L =  9;    // Elapsed write clock-cycles, lo word
     localparam REG_CTL_STAT  = 10;    // Combined control and status register
+    localparam REG_TRC_CTL   = 11;    // Trace control and status register
+    localparam REG_TRC_COUNT = 12;    // Number of trace entries recorded since the trace was armed
+    localparam REG_TRC_INDEX = 13;    // Index of the trace entry to read back
+    localparam REG_TRC_DAT_H = 14;    // Trace entry at REG_TRC_INDEX, hi word
+    localparam REG_TRC_DAT_L = 15;    // Trace entry at REG_TRC_INDEX, lo word
+
+    // This calculation assumes TRACE_DEPTH is a power of 2
+    localparam TRACE_ADDR_BITS = $clog2(TRACE_DEPTH);
 
     // Storage for the above registers.  (We don't actually store CTL_STAT or the result registers)    
     reg[31:0] register[0:5];
@@ -179,6 +220,22 @@ module measure_bw#
     // When these are pulsed high, the bandwidth tests begin
     reg start_read, start_write;       
 
+    // When these are pulsed high, the trace buffer is armed, triggered, or stopped
+    reg trace_arm, trace_trigger, trace_stop;
+
+    // When this is 1, the trace buffer stops recording when it fills rather than wrapping
+    reg trace_one_shot;
+
+    // Status of the trace buffer
+    reg trace_armed, trace_recording, trace_wrapped;
+
+    // The number of trace entries recorded since the trace was armed
+    reg[31:0] trace_count;
+
+    // The index of the trace entry that the AXI master wants to read, and that entry
+    reg[TRACE_ADDR_BITS-1:0] trace_index;
+    reg[63:0]                trace_rdata;
+
     // When the measurement starts, these will contain the measurement parameters
     reg[31:0] xfer_count, xfer_count_less_1, xfer_block_size;
     
@@ -378,6 +435,20 @@ module measure_bw#
                                     s_axi_rdata[1]    <= ~is_write_engine_idle;
                                     s_axi_rdata[31:2] <= 0;
                                 end
+
+                REG_TRC_CTL:    begin
+                                    s_axi_rdata[0]     <= trace_armed;
+                                    s_axi_rdata[1]     <= trace_recording;
+                                    s_axi_rdata[2]     <= trace_wrapped;
+                                    s_axi_rdata[3]     <= trace_one_shot;
+                                    s_axi_rdata[23:4]  <= 0;
+                                    s_axi_rdata[31:24] <= TRACE_ADDR_BITS;
+                                end
+
+                REG_TRC_COUNT:  s_axi_rdata <= trace_count;
+                REG_TRC_INDEX:  s_axi_rdata <= trace_index;
+                REG_TRC_DAT_H:  s_axi_rdata <= trace_rdata[63:32];
+                REG_TRC_DAT_L:  s_axi_rdata <= trace_rdata[31: 0];
                 
                 // A read of an unknown register results in a SLVERR response
                 default:      begin
@@ -409,6 +480,11 @@ module measure_bw#
     //   beats_per_burst = The number of beats in an AXI burst
     //   xfer_block_size = The size of a single data-burst in bytes
     //   xfer_count      = The number of blocks to data to read
+    //
+    // If the write was to the REG_TRC_CTL:
+    //   If bit 0 = 1, trace_arm is pulsed high for one cycle and trace_one_shot is set to bit 3
+    //   If bit 1 = 1, trace_trigger is pulsed high for one cycle
+    //   If bit 2 = 1, trace_stop is pulsed high for one cycle
     //=========================================================================================================
     
     always @(posedge AXI_ACLK) begin
@@ -417,12 +493,19 @@ module measure_bw#
         start_read  <= 0;
         start_write <= 0;
 
+        // The trace controls are one-clock-cycle pulses too
+        trace_arm     <= 0;
+        trace_trigger <= 0;
+        trace_stop    <= 0;
+
         // The cycle counter increments continuously, once per clock cycle
         cycle_counter <= cycle_counter + 1;
 
         if (AXI_ARESETN == 0) begin
             user_write_idle <= 1;
             xfer_count      <= 0;
+            trace_one_shot  <= 0;
+            trace_index     <= 0;
 
         end else if (user_write_start) begin
             
@@ -450,6 +533,17 @@ module measure_bw#
                                     start_read        <= s_axi_wdata[0];
                                     start_write       <= s_axi_wdata[1];
                                 end
+
+                // A write to the trace control register arms, triggers, or stops the trace buffer
+                REG_TRC_CTL:    begin
+                                    trace_arm     <= s_axi_wdata[0];
+                                    trace_trigger <= s_axi_wdata[1];
+                                    trace_stop    <= s_axi_wdata[2];
+                                    if (s_axi_wdata[0]) trace_one_shot <= s_axi_wdata[3];
+                                end
+
+                // Select which trace entry will be read back via REG_TRC_DAT_H and REG_TRC_DAT_L
+                REG_TRC_INDEX:  trace_index <= s_axi_wdata;
                      
                 // A write to an unknown register results in a SLVERR response
                 default:      s_axi_bresp <= SLVERR;
@@ -759,6 +853,96 @@ module measure_bw#
     end
     //=========================================================================================================
 
+
+
+    //<><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><
+    //<><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><
+    //            The logic in this section records AXI transactions into the trace buffer
+    //<><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><
+    //<><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><><
+
+
+    //=========================================================================================================
+    // The trace buffer itself, a block RAM that is TRACE_DEPTH entries of 64 bits each
+    //=========================================================================================================
+    (* ram_style = "block" *) reg[63:0] trace_ram[0:TRACE_DEPTH-1];
+
+    // The number of clock cycles since the trace was triggered
+    reg[47:0] trace_timestamp;
+
+    // One bit for each type of AXI handshake that we record
+    wire[3:0] trace_event = {M_B_HANDSHAKE, M_AW_HANDSHAKE, M_R_HANDSHAKE & M_AXI_RLAST, M_AR_HANDSHAKE};
+
+    // An entry is written to the trace buffer on every cycle in which at least one event occurs
+    wire trace_write = trace_recording & (trace_event != 0);
+
+    // This is where the next trace entry will be stored
+    wire[TRACE_ADDR_BITS-1:0] trace_wptr = trace_count[TRACE_ADDR_BITS-1:0];
+
+    always @(posedge AXI_ACLK) begin
+        if (trace_write) trace_ram[trace_wptr] <= {trace_event, M_AXI_ARID, M_AXI_AWID, 4'h0, trace_timestamp};
+        trace_rdata <= trace_ram[trace_index];
+    end
+    //=========================================================================================================
+
+
+    //=========================================================================================================
+    // State machine that controls recording into the trace buffer
+    //
+    // To arm:     pulse trace_arm high for one cycle
+    // To trigger: while armed, pulse trace_trigger high for one cycle or start a bandwidth measurement
+    // To stop:    pulse trace_stop high for one cycle
+    //
+    // When trace_one_shot is 1, recording stops automatically once the trace buffer is full
+    //=========================================================================================================
+    always @(posedge AXI_ACLK) begin
+
+        // The timestamp increments continuously, once per clock cycle
+        trace_timestamp <= trace_timestamp + 1;
+
+        // If we're in RESET mode...
+        if (AXI_ARESETN == 0) begin
+            trace_armed     <= 0;
+            trace_recording <= 0;
+            trace_wrapped   <= 0;
+            trace_count     <= 0;
+        end else begin
+
+            // Keep track of every entry we write, and notice when the trace buffer fills up
+            if (trace_write) begin
+                trace_count <= trace_count + 1;
+                if (trace_count == TRACE_DEPTH - 1) begin
+                    if (trace_one_shot)
+                        trace_recording <= 0;
+                    else
+                        trace_wrapped   <= 1;
+                end
+            end
+
+            // Arming the trace clears the buffer and waits for a trigger
+            if (trace_arm) begin
+                trace_armed     <= 1;
+                trace_recording <= 0;
+                trace_wrapped   <= 0;
+                trace_count     <= 0;
+            end
+
+            // On a trigger, start recording with a timestamp of 0
+            if ((trace_armed || trace_arm) && (trace_trigger || start_read || start_write)) begin
+                trace_armed     <= 0;
+                trace_recording <= 1;
+                trace_timestamp <= 0;
+            end
+
+            // A stop request ends recording, and cancels any pending trigger
+            if (trace_stop) begin
+                trace_armed     <= 0;
+                trace_recording <= 0;
+            end
+        end
+    end
+    //=========================================================================================================
+
 endmodule
 
 
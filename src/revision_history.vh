@@ -3,11 +3,12 @@
 //    Date         Version  Who  Changes
 // -----------------------------------------------------------------------------------------------
 // 06-Aug-2022    1.0.0000  DWW  Initial creation
+// 18-Oct-2026    1.1.0000  AGT  Added AXI transaction trace buffer to measure_bw
 //================================================================================================
 localparam VERSION_MAJOR = 1;
-localparam VERSION_MINOR = 0;
+localparam VERSION_MINOR = 1;
 localparam VERSION_BUILD = 0;
 
-localparam VERSION_MONTH = 8;
-localparam VERSION_DAY   = 6;
-localparam VERSION_YEAR  = 2022;
+localparam VERSION_MONTH = 10;
+localparam VERSION_DAY   = 18;
+localparam VERSION_YEAR  = 2026;